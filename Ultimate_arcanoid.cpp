@@ -4,11 +4,15 @@
 #pragma comment(lib, "Msimg32.lib")
 
 #include <windows.h>
-#include <vector>
 #include <cmath>
 #include <algorithm>
 #include <cstdlib> // для rand()
 #include <ctime>   // time
+#include <cstdio>  // snprintf для perf-HUD
+#include <new>     // placement new, std::bad_alloc
+#include <atomic>  // счётчик выделений в куче
+#include <cassert>
+#include <malloc.h> // _aligned_malloc для выровненного operator new
 #include <wingdi.h> // для TransparentBlt
 
 // -----------------------------
@@ -22,6 +26,31 @@ namespace GameConfig
     // 
     // Настройки камеры/зум-режима
     constexpr float ZoomScale = 3.0f;     // во сколько раз увеличиваем при удержании W
+    constexpr float CameraScaleLerp = 0.12f; // доля пути к целевому масштабу за кадр (при 60 FPS)
+    constexpr float CameraMoveLerp = 0.15f;  // доля пути к мячу за кадр (при 60 FPS)
+    constexpr float CameraDeadZone = 0.3f;   // доля видимой области вокруг центра, где мяч не двигает камеру
+
+    // Размер мира относительно окна (мир больше экрана, камера ездит по нему)
+    constexpr float WorldScale = 3.0f;
+
+    // Уровни детализации (LOD)
+    constexpr int LodCellSize = 4;            // один пиксель LOD-слоя = 4x4 пикселя мира
+    constexpr float LodDetailRadius = 400.0f; // полная детализация блоков только в этом радиусе от мяча
+    constexpr float LodDetailMinScale = 0.5f; // при более мелком масштабе блоки рисуются только LOD-слоем
+    constexpr int BlockGridCell = 256;        // ячейка сетки поиска блоков (должна быть больше блока)
+
+    // Память
+    constexpr size_t LevelArenaBytes = 16 * 1024 * 1024; // статические данные уровня
+    constexpr size_t FrameArenaBytes = 1024 * 1024;      // временные данные одного кадра
+    constexpr int TraceTrailLength = 1024;               // точек в хвосте трассировки (старые затираются)
+
+    // Perf-HUD: в отладочной сборке включён сразу, переключается клавишей H
+#ifdef _DEBUG
+    constexpr bool PerfHudDefault = true;
+#else
+    constexpr bool PerfHudDefault = false;
+#endif
+    constexpr int PerfLogInterval = 60; // раз во сколько кадров писать статистику в отладочный лог
 
     // Скорости мяча под горячими клавишами
     constexpr float BallSpeedSlow = 1.0f;  // при удержании S
@@ -50,6 +79,172 @@ namespace GameConfig
     constexpr int BlocksStartY = 100;
 }
 
+// -----------------------------
+// Память: счётчик выделений и арены
+// -----------------------------
+
+// Счётчик выделений в куче: глобальные operator new/delete подменены,
+// чтобы perf-HUD показывал, сколько раз за кадр мы ходили в кучу
+// (цель в установившемся режиме — ноль).
+namespace AllocStats
+{
+    std::atomic<size_t> count(0); // всего успешных вызовов new
+    std::atomic<size_t> bytes(0); // всего байт через new
+
+    // Учитываем только удавшиеся выделения
+    inline void* Counted(void* p, size_t size)
+    {
+        if (p)
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+        return p;
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (size == 0) size = 1;
+    if (void* p = AllocStats::Counted(malloc(size), size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#ifdef __cpp_aligned_new
+// Выровненные формы (C++17, типы с alignas больше стандартного) — тоже через счётчик
+void* operator new(size_t size, std::align_val_t align)
+{
+    if (size == 0) size = 1;
+    if (void* p = AllocStats::Counted(_aligned_malloc(size, (size_t)align), size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t align) { return operator new(size, align); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size, align); }
+    catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return operator new(size, align, std::nothrow); }
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#endif
+
+// Линейная арена: память берётся один раз, выделение — сдвиг указателя,
+// освобождение — только целиком (Reset) или откатом к отметке (Mark/Rewind).
+// Деструкторы объектов в арене сами не вызываются.
+
+class LinearArena
+{
+    const char* name; // для сообщений о переполнении
+    char* base;
+    size_t capacity;
+    size_t used;
+    size_t peak;
+    int overflows;    // сколько выделений не поместилось
+
+public:
+    LinearArena() : name("arena"), base(nullptr), capacity(0), used(0), peak(0), overflows(0) {}
+    ~LinearArena() { free(base); }
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void Init(const char* arenaName, size_t bytes)
+    {
+        free(base);
+        name = arenaName;
+        base = (char*)malloc(bytes);
+        capacity = base ? bytes : 0;
+        used = peak = 0;
+        overflows = 0;
+    }
+
+    // nullptr, если арена переполнена — вызывающий код считает, что данных нет.
+    // Переполнение пишется в отладочный лог, считается для perf-HUD
+    // и останавливает отладочную сборку.
+    void* Alloc(size_t bytes, size_t align)
+    {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if (start + bytes > capacity)
+        {
+            char msg[160];
+            snprintf(msg, sizeof(msg), "[arena] %s overflow: requested %zu B, available %zu B of %zu B\n",
+                name, bytes, capacity - used, capacity);
+            OutputDebugStringA(msg);
+            overflows++;
+            assert(!"arena overflow");
+            return nullptr;
+        }
+        used = start + bytes;
+        if (used > peak) peak = used;
+        return base + start;
+    }
+
+    template <typename T>
+    T* AllocArray(int n)
+    {
+        if (n <= 0) return nullptr;
+        T* arr = (T*)Alloc(sizeof(T) * n, alignof(T));
+        if (!arr) return nullptr;
+        for (int i = 0; i < n; i++) new (&arr[i]) T();
+        return arr;
+    }
+
+    size_t Mark() const { return used; }
+    void Rewind(size_t mark) { used = mark; }
+    void Reset() { used = 0; }
+
+    size_t GetUsed() const { return used; }
+    size_t GetPeak() const { return peak; }
+    size_t GetCapacity() const { return capacity; }
+    int GetOverflows() const { return overflows; }
+};
+
+// Массив, лежащий в арене (указатель + количество), с интерфейсом как у vector
+template <typename T>
+struct ArenaArray
+{
+    T* data;
+    int count;
+
+    ArenaArray() : data(nullptr), count(0) {}
+
+    void Allocate(LinearArena& arena, int n)
+    {
+        data = arena.AllocArray<T>(n);
+        count = data ? n : 0;
+    }
+    // Вызвать деструкторы перед сбросом арены
+    void Destroy()
+    {
+        for (int i = 0; i < count; i++) data[i].~T();
+        data = nullptr;
+        count = 0;
+    }
+
+    T* begin() const { return data; }
+    T* end() const { return data + count; }
+    int size() const { return count; }
+    T& operator[](int i) const { return data[i]; }
+};
+
+// Общий контекст для вывода битмапов (создаётся один раз в InitWindow,
+// чтобы не создавать и не удалять DC на каждый спрайт каждый кадр)
+HDC bitmapDC = nullptr;
+
 // Базовый класс Sprite — всё, что умеет двигаться и рисоваться
 
 class Sprite
@@ -60,12 +255,13 @@ protected: //Ключевое слово Протектед - модификат
     float dx, dy;        // Направление движения
     float speed;         // Скорость
     HBITMAP hBitmap;     // Битмап для отрисовки
+    int bmWidth, bmHeight; // Размеры битмапа (кэшируются в SetBitmap)
 
 public://Ключевое слово Паблик - модификатор доступа из любой части программы 
     //Конструктор класса - специальная функция для создания объекта, чтобы инициализировать члены класса
     Sprite(float x = 0, float y = 0, float w = 0, float h = 0)
         : x(x), y(y), width(w), height(h),
-        dx(0), dy(0), speed(0), hBitmap(nullptr)
+        dx(0), dy(0), speed(0), hBitmap(nullptr), bmWidth(0), bmHeight(0)
     {
     }
     //virtual нужен, чтобы если объект наследника (например Ball) удаляется через указатель на Sprite, 
@@ -81,13 +277,9 @@ public://Ключевое слово Паблик - модификатор до
     // Отрисовка с учётом смещения и масштаба вида
     void DrawView(HDC hdc, float viewX, float viewY, float viewScale)
     {
-        if (hBitmap)
+        if (hBitmap && bitmapDC)
         {
-            HDC memDC = CreateCompatibleDC(hdc);
-            HBITMAP old = (HBITMAP)SelectObject(memDC, hBitmap);
-
-            BITMAP bm;
-            GetObject(hBitmap, sizeof(BITMAP), &bm);
+            HBITMAP old = (HBITMAP)SelectObject(bitmapDC, hBitmap);
 
             int dstX = (int)((x - viewX) * viewScale);
             int dstY = (int)((y - viewY) * viewScale);
@@ -96,12 +288,11 @@ public://Ключевое слово Паблик - модификатор до
 
             TransparentBlt(
                 hdc, dstX, dstY, dstW, dstH,
-                memDC, 0, 0, bm.bmWidth, bm.bmHeight,
+                bitmapDC, 0, 0, bmWidth, bmHeight,
                 RGB(255, 255, 255)
             );
 
-            SelectObject(memDC, old);
-            DeleteDC(memDC);
+            SelectObject(bitmapDC, old);
         }
         else {
             int dstX = (int)((x - viewX) * viewScale);
@@ -113,7 +304,14 @@ public://Ключевое слово Паблик - модификатор до
     }
 
     // --- Геттеры/сеттеры ---
-    void SetBitmap(HBITMAP bmp) { hBitmap = bmp; }
+    void SetBitmap(HBITMAP bmp)
+    {
+        hBitmap = bmp;
+        BITMAP bm = {};
+        if (bmp) GetObject(bmp, sizeof(BITMAP), &bm);
+        bmWidth = bm.bmWidth;
+        bmHeight = bm.bmHeight;
+    }
     void SetPosition(float nx, float ny) { x = nx; y = ny; }
     void SetSize(float w, float h) { width = w; height = h; }
     void SetSpeed(float s) { speed = s; }
@@ -259,43 +457,555 @@ PlayerPlatform player(0, 0, 0, 0);
 Ball ball(0, 0, 0);
 Ball balltrace(0, 0, 0);
 
-std::vector<Block> blocks; // Массив блоков вместо одного
+// Арены: уровень живёт до следующего InitGame, кадровая очищается в начале каждого кадра
+LinearArena levelArena;
+LinearArena frameArena;
+
+// Статистика кадра для perf-HUD и отладочного лога
+struct PerfStats
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER frameStart;
+    size_t allocsAtStart, bytesAtStart;
+    double frameMs;         // время работы прошлого кадра (без Sleep)
+    float frameDt;          // полный период прошлого кадра в секундах (со Sleep)
+    size_t frameAllocs;     // выделений в куче за прошлый кадр
+    size_t frameAllocBytes;
+    int frame;
+
+    PerfStats() : frequency(), frameStart(), allocsAtStart(0), bytesAtStart(0),
+        frameMs(0.0), frameDt(1.0f / 60.0f), frameAllocs(0), frameAllocBytes(0), frame(0) {
+    }
+};
+
+PerfStats perf;
+
+void InitMemory()
+{
+    levelArena.Init("level", GameConfig::LevelArenaBytes);
+    frameArena.Init("frame", GameConfig::FrameArenaBytes);
+    QueryPerformanceFrequency(&perf.frequency);
+}
+
+// Начало кадра: временные данные прошлого кадра больше не нужны
+void BeginFrame()
+{
+    frameArena.Reset();
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    if (perf.frameStart.QuadPart != 0)
+    {
+        // Ограничиваем, чтобы после паузы (перетаскивание окна, отладчик) камера не прыгала
+        float dt = (float)(now.QuadPart - perf.frameStart.QuadPart) / perf.frequency.QuadPart;
+        perf.frameDt = (std::min)(dt, 0.1f);
+    }
+    perf.frameStart = now;
+    perf.allocsAtStart = AllocStats::count.load(std::memory_order_relaxed);
+    perf.bytesAtStart = AllocStats::bytes.load(std::memory_order_relaxed);
+}
+
+void EndFrame()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    perf.frameMs = (now.QuadPart - perf.frameStart.QuadPart) * 1000.0 / perf.frequency.QuadPart;
+    perf.frameAllocs = AllocStats::count.load(std::memory_order_relaxed) - perf.allocsAtStart;
+    perf.frameAllocBytes = AllocStats::bytes.load(std::memory_order_relaxed) - perf.bytesAtStart;
+    perf.frame++;
+
+    if (perf.frame % GameConfig::PerfLogInterval == 0)
+    {
+        char line[160];
+        snprintf(line, sizeof(line), "[perf] frame %d: %.2f ms, heap allocs %zu (%zu B)\n",
+            perf.frame, perf.frameMs, perf.frameAllocs, perf.frameAllocBytes);
+        OutputDebugStringA(line);
+    }
+}
+
+bool showPerfHud = GameConfig::PerfHudDefault;
+bool perfHudKeyDown = false;
+
+// Переключение perf-HUD по нажатию H (а не по удержанию)
+void UpdatePerfHudToggle()
+{
+    bool down = (GetAsyncKeyState('H') & 0x8000) != 0;
+    if (down && !perfHudKeyDown) showPerfHud = !showPerfHud;
+    perfHudKeyDown = down;
+}
+
+void DrawPerfHud(HDC hdc)
+{
+    if (!showPerfHud) return;
+
+    // Буфер на стеке — сам HUD в кучу не ходит
+    char line[200];
+    int len = snprintf(line, sizeof(line),
+        "%.2f ms | heap allocs/frame: %zu (%zu B) | level arena: %zu KB | frame arena peak: %zu KB",
+        perf.frameMs, perf.frameAllocs, perf.frameAllocBytes,
+        levelArena.GetUsed() / 1024,
+        frameArena.GetPeak() / 1024);
+    if (len < 0) return;
+    if (len >= (int)sizeof(line)) len = (int)sizeof(line) - 1;
+
+    SetBkMode(hdc, TRANSPARENT);
+    SetTextColor(hdc, RGB(255, 255, 0));
+    TextOutA(hdc, 10, 10, line, len);
+
+    // Переполнение арен — данные уровня или кадра потеряны, показываем отдельно
+    if (levelArena.GetOverflows() > 0 || frameArena.GetOverflows() > 0)
+    {
+        len = snprintf(line, sizeof(line), "ARENA OVERFLOW: level %d, frame %d (see debug log)",
+            levelArena.GetOverflows(), frameArena.GetOverflows());
+        if (len < 0) return;
+        if (len >= (int)sizeof(line)) len = (int)sizeof(line) - 1;
+        SetTextColor(hdc, RGB(255, 0, 0));
+        TextOutA(hdc, 10, 30, line, len);
+    }
+}
+
+ArenaArray<Block> blocks; // Массив блоков в арене уровня
 HBITMAP hBack;
-std::vector<POINT> ballTrace;
+int hBackWidth = 0, hBackHeight = 0;
+// Хвост трассировки — кольцевой буфер в арене уровня: память выделяется
+// один раз, новые точки затирают самые старые
+struct TraceTrail
+{
+    ArenaArray<POINT> points;
+    int head;  // куда писать следующую точку
+    int count; // сколько точек заполнено (всегда с начала массива)
+
+    TraceTrail() : head(0), count(0) {}
+
+    void Init(LinearArena& arena, int capacity)
+    {
+        points.Allocate(arena, capacity);
+        head = count = 0;
+    }
+
+    // Повтор последней точки (курсор стоит на месте) не добавляем
+    void Push(POINT p)
+    {
+        if (points.size() == 0) return;
+        if (count > 0)
+        {
+            const POINT& last = points[(head + points.size() - 1) % points.size()];
+            if (last.x == p.x && last.y == p.y) return;
+        }
+        points[head] = p;
+        head = (head + 1) % points.size();
+        if (count < points.size()) count++;
+    }
+
+    POINT* begin() const { return points.begin(); }
+    POINT* end() const { return points.begin() + count; }
+};
+
+TraceTrail ballTrace;
 //std::vector<TracePoint> ballTracePath;
 bool ballactive = false;
 
-// Параметры вида (камера/зум)
-bool zoomMode = false;
-float viewX = 0.0f;
-float viewY = 0.0f;
-float viewScale = 1.0f;
-const float zoomScale = GameConfig::ZoomScale; // масштаб при удержании W
-
-void UpdateView()
-{
-    zoomMode = (GetAsyncKeyState('W') & 0x8000) != 0;
-    if (zoomMode)
-    {
-        viewScale = zoomScale;
-        float visibleW = window.width / viewScale;
-        float visibleH = window.height / viewScale;
-        viewX = ball.GetX() - visibleW * 0.5f;
-        viewY = ball.GetY() - visibleH * 0.5f;
-        // Ограничение в пределах размера сцены (здесь = размер окна)
-        if (viewX < 0.0f) viewX = 0.0f;
-        if (viewY < 0.0f) viewY = 0.0f;
-        float maxVX = (float)window.width - visibleW;
-        float maxVY = (float)window.height - visibleH;
-        if (viewX > maxVX) viewX = maxVX;
-        if (viewY > maxVY) viewY = maxVY;
+// Размеры мира (мир больше окна, задаётся в InitGame)
+struct World
+{
+    float width, height;
+
+    World() : width(0.0f), height(0.0f) {}
+};
+
+World world;
+
+// Камера — плавно следует за мячом и плавно меняет масштаб
+
+class Camera
+{
+    float centerX, centerY; // Точка мира в центре экрана
+    float scale;            // Текущий масштаб
+    float targetScale;      // Масштаб, к которому стремимся
+    float viewX, viewY;     // Левый верхний угол видимой области в координатах мира
+
+public:
+    Camera() : centerX(0), centerY(0), scale(1.0f), targetScale(1.0f), viewX(0), viewY(0) {}
+
+    // Мгновенно поставить камеру (без интерполяции), например при старте уровня
+    void Snap(float cx, float cy, float s)
+    {
+        centerX = cx; centerY = cy;
+        scale = targetScale = s;
+        Clamp();
+    }
+
+    void SetTargetScale(float s) { targetScale = s; }
+
+    // Доля пути за кадр длительностью dt секунд: Lerp задан для 60 FPS,
+    // пересчёт через степень даёт одинаковую скорость при любой частоте кадров
+    static float LerpFactor(float lerp, float dt)
+    {
+        return 1.0f - powf(1.0f - lerp, dt * 60.0f);
+    }
+
+    // Шаг интерполяции: масштаб интерполируем в логарифмах, чтобы переход
+    // 0.3 -> 1 -> 3 ощущался одинаково быстрым на каждом уровне зума.
+    // Камера сдвигается, только когда мяч выходит из мёртвой зоны у центра экрана.
+    void Update(float focusX, float focusY, float dt)
+    {
+        float logScale = logf(scale);
+        logScale += (logf(targetScale) - logScale) * LerpFactor(GameConfig::CameraScaleLerp, dt);
+        scale = expf(logScale);
+
+        float zoneW = VisibleW() * GameConfig::CameraDeadZone * 0.5f;
+        float zoneH = VisibleH() * GameConfig::CameraDeadZone * 0.5f;
+        float targetX = centerX, targetY = centerY;
+        if (focusX > centerX + zoneW) targetX = focusX - zoneW;
+        if (focusX < centerX - zoneW) targetX = focusX + zoneW;
+        if (focusY > centerY + zoneH) targetY = focusY - zoneH;
+        if (focusY < centerY - zoneH) targetY = focusY + zoneH;
+
+        float k = LerpFactor(GameConfig::CameraMoveLerp, dt);
+        centerX += (targetX - centerX) * k;
+        centerY += (targetY - centerY) * k;
+        Clamp();
+    }
+
+    // Ограничение видимой области размерами мира.
+    // Если мир меньше экрана (сильное отдаление) — центрируем его.
+    void Clamp()
+    {
+        float visibleW = VisibleW();
+        float visibleH = VisibleH();
+        if (visibleW >= world.width) centerX = world.width * 0.5f;
+        else centerX = (std::min)((std::max)(centerX, visibleW * 0.5f), world.width - visibleW * 0.5f);
+        if (visibleH >= world.height) centerY = world.height * 0.5f;
+        else centerY = (std::min)((std::max)(centerY, visibleH * 0.5f), world.height - visibleH * 0.5f);
+        viewX = centerX - visibleW * 0.5f;
+        viewY = centerY - visibleH * 0.5f;
     }
+
+    float VisibleW() const { return window.width / scale; }
+    float VisibleH() const { return window.height / scale; }
+
+    // Перевод экранных координат (например, курсора) в координаты мира
+    float ScreenToWorldX(float sx) const { return viewX + sx / scale; }
+    float ScreenToWorldY(float sy) const { return viewY + sy / scale; }
+
+    float GetViewX() const { return viewX; }
+    float GetViewY() const { return viewY; }
+    float GetScale() const { return scale; }
+};
+
+Camera camera;
+
+// Сетка поиска блоков: индексы блоков, разложенные по ячейкам мира.
+// Хранится «плоско» (начало ячейки + общий массив индексов), блок попадает
+// в ячейку своего левого верхнего угла, поэтому при запросе область
+// расширяется на одну ячейку влево/вверх (блок меньше ячейки).
+
+class BlockGrid
+{
+    int cols, rows;
+    int* cellStart; // cellStart[c]..cellStart[c+1] — блоки ячейки c
+    int* cellItems;
+
+    int CellX(float x) const { return (std::min)((std::max)((int)(x / GameConfig::BlockGridCell), 0), cols - 1); }
+    int CellY(float y) const { return (std::min)((std::max)((int)(y / GameConfig::BlockGridCell), 0), rows - 1); }
+
+public:
+    BlockGrid() : cols(0), rows(0), cellStart(nullptr), cellItems(nullptr) {}
+
+    // Память сетки берётся из арены уровня
+    void Build(LinearArena& arena, const ArenaArray<Block>& blocks)
+    {
+        cols = (int)ceil(world.width / GameConfig::BlockGridCell);
+        rows = (int)ceil(world.height / GameConfig::BlockGridCell);
+        if (cols < 1) cols = 1;
+        if (rows < 1) rows = 1;
+
+        cellStart = arena.AllocArray<int>(cols * rows + 1);
+        cellItems = arena.AllocArray<int>(blocks.size());
+        if (!cellStart || (blocks.size() > 0 && !cellItems))
+        {
+            cols = rows = 0;
+            return;
+        }
+
+        // Сортировка подсчётом: сначала размеры ячеек, потом раскладка
+        for (auto& block : blocks)
+            cellStart[CellY(block.GetY()) * cols + CellX(block.GetX()) + 1]++;
+        for (int c = 0; c < cols * rows; c++)
+            cellStart[c + 1] += cellStart[c];
+
+        // Раскладка сдвигает cellStart[c] к концу ячейки, затем возвращаем на место
+        for (int i = 0; i < blocks.size(); i++)
+        {
+            int c = CellY(blocks[i].GetY()) * cols + CellX(blocks[i].GetX());
+            cellItems[cellStart[c]++] = i;
+        }
+        for (int c = cols * rows; c > 0; c--)
+            cellStart[c] = cellStart[c - 1];
+        cellStart[0] = 0;
+    }
+
+    // Вызывает fn(index) для каждого блока, который может пересекать прямоугольник
+    template <typename Fn>
+    void Query(float left, float top, float right, float bottom, Fn fn) const
+    {
+        if (cols == 0) return;
+        int cx0 = CellX(left) - 1, cy0 = CellY(top) - 1;
+        int cx1 = CellX(right), cy1 = CellY(bottom);
+        if (cx0 < 0) cx0 = 0;
+        if (cy0 < 0) cy0 = 0;
+        for (int cy = cy0; cy <= cy1; cy++)
+            for (int cx = cx0; cx <= cx1; cx++)
+            {
+                int c = cy * cols + cx;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; k++)
+                    fn(cellItems[k]);
+            }
+    }
+
+    // Индексы блоков-кандидатов в прямоугольнике — массивом в арене.
+    // Размер известен заранее по cellStart, поэтому выделение одно и точное.
+    ArenaArray<int> Collect(LinearArena& arena, float left, float top, float right, float bottom) const
+    {
+        ArenaArray<int> out;
+        if (cols == 0) return out;
+        int cx0 = (std::max)(CellX(left) - 1, 0), cy0 = (std::max)(CellY(top) - 1, 0);
+        int cx1 = CellX(right), cy1 = CellY(bottom);
+
+        int total = 0;
+        for (int cy = cy0; cy <= cy1; cy++)
+            total += cellStart[cy * cols + cx1 + 1] - cellStart[cy * cols + cx0];
+
+        out.Allocate(arena, total);
+        if (out.size() < total) return out;
+
+        int n = 0;
+        Query(left, top, right, bottom, [&](int i) { out[n++] = i; });
+        return out;
+    }
+};
+
+BlockGrid blockGrid;
+
+// LOD-слой: заранее отрисованная уменьшенная копия всех блоков сплошными
+// прямоугольниками. Дальние блоки выводятся одним TransparentBlt этого слоя,
+// поэтому стоимость кадра не зависит от количества блоков на уровне.
+
+class LodLayer
+{
+    HDC dc;
+    HBITMAP bmp;
+    HBITMAP oldBmp;
+    HBRUSH blockBrush;
+    HBRUSH clearBrush;
+    int width, height;
+
+public:
+    static constexpr COLORREF TransparentColor = RGB(255, 255, 255);
+
+    LodLayer() : dc(nullptr), bmp(nullptr), oldBmp(nullptr),
+        blockBrush(nullptr), clearBrush(nullptr), width(0), height(0) {
+    }
+
+    // Средний цвет битмапа блока — им заливаем блок в LOD-слое.
+    // Белые пиксели не считаем: TransparentBlt их не рисует, на экране их нет.
+    static COLORREF AverageColor(HDC refDC, HBITMAP src)
+    {
+        COLORREF color = RGB(180, 60, 40);
+        if (!src) return color;
+
+        BITMAP bm; GetObject(src, sizeof(BITMAP), &bm);
+        if (bm.bmWidth <= 0 || bm.bmHeight <= 0) return color;
+
+        // Пиксели читаем по одной 32-битной строке в буфер из арены уровня
+        // (отметка откатывается сразу, данные уровня не затрагиваются)
+        BITMAPINFO info = {};
+        info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        info.bmiHeader.biWidth = bm.bmWidth;
+        info.bmiHeader.biHeight = bm.bmHeight;
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = 32;
+        info.bmiHeader.biCompression = BI_RGB;
+
+        size_t mark = levelArena.Mark();
+        ArenaArray<DWORD> row;
+        row.Allocate(levelArena, bm.bmWidth);
+
+        // В DIB порядок байт BGR: младший байт — синий
+        unsigned long long r = 0, g = 0, b = 0, n = 0;
+        for (int y = 0; y < bm.bmHeight && row.size() > 0; y++)
+        {
+            if (!GetDIBits(refDC, src, y, 1, row.begin(), &info, DIB_RGB_COLORS)) break;
+            for (DWORD p : row)
+            {
+                if ((p & 0xFFFFFF) == 0xFFFFFF) continue;
+                b += p & 0xFF;
+                g += (p >> 8) & 0xFF;
+                r += (p >> 16) & 0xFF;
+                n++;
+            }
+        }
+        if (n > 0) color = RGB(r / n, g / n, b / n);
+        levelArena.Rewind(mark);
+
+        // Белый зарезервирован под прозрачность
+        if (color == TransparentColor) color = RGB(254, 254, 254);
+        return color;
+    }
+
+    void Release()
+    {
+        if (dc)
+        {
+            SelectObject(dc, oldBmp);
+            DeleteDC(dc);
+            dc = nullptr;
+        }
+        if (bmp) { DeleteObject(bmp); bmp = nullptr; }
+        if (blockBrush) { DeleteObject(blockBrush); blockBrush = nullptr; }
+        if (clearBrush) { DeleteObject(clearBrush); clearBrush = nullptr; }
+    }
+
+    void Build(HDC refDC, const ArenaArray<Block>& blocks, COLORREF blockColor)
+    {
+        Release();
+        width = (int)ceil(world.width / GameConfig::LodCellSize);
+        height = (int)ceil(world.height / GameConfig::LodCellSize);
+
+        dc = CreateCompatibleDC(refDC);
+        bmp = CreateCompatibleBitmap(refDC, width, height);
+        oldBmp = (HBITMAP)SelectObject(dc, bmp);
+        blockBrush = CreateSolidBrush(blockColor);
+        clearBrush = CreateSolidBrush(TransparentColor);
+
+        RECT all = { 0, 0, width, height };
+        FillRect(dc, &all, clearBrush);
+        for (auto& block : blocks)
+        {
+            if (block.active) Paint(block, blockBrush);
+        }
+    }
+
+    // Прямоугольник блока в пикселях слоя (округлён наружу до целых ячеек)
+    static RECT Footprint(const Block& block)
+    {
+        RECT r;
+        r.left = (LONG)(block.GetX() / GameConfig::LodCellSize);
+        r.top = (LONG)(block.GetY() / GameConfig::LodCellSize);
+        r.right = (LONG)ceil((block.GetX() + block.GetW()) / GameConfig::LodCellSize);
+        r.bottom = (LONG)ceil((block.GetY() + block.GetH()) / GameConfig::LodCellSize);
+        return r;
+    }
+
+    void Paint(const Block& block, HBRUSH brush)
+    {
+        RECT r = Footprint(block);
+        FillRect(dc, &r, brush);
+    }
+
+    // Вырезать след блока в слое из области рисования hdc — под детальным блоком
+    // слой не выводится (иначе он просвечивает через белое и торчит каймой
+    // от округления до ячеек). Экранный прямоугольник округляем наружу.
+    static void ExcludeBlock(HDC hdc, const Block& block, const Camera& cam)
+    {
+        RECT r = Footprint(block);
+        float scale = cam.GetScale();
+        ExcludeClipRect(hdc,
+            (int)floorf((r.left * GameConfig::LodCellSize - cam.GetViewX()) * scale),
+            (int)floorf((r.top * GameConfig::LodCellSize - cam.GetViewY()) * scale),
+            (int)ceilf((r.right * GameConfig::LodCellSize - cam.GetViewX()) * scale),
+            (int)ceilf((r.bottom * GameConfig::LodCellSize - cam.GetViewY()) * scale));
+    }
+
+    // Вывод видимой части слоя на экран с учётом камеры
+    void DrawView(HDC hdc, const Camera& cam)
+    {
+        if (!dc) return;
+
+        // Пересечение видимой области с миром (при отдалении мир может быть меньше экрана)
+        float left = (std::max)(cam.GetViewX(), 0.0f);
+        float top = (std::max)(cam.GetViewY(), 0.0f);
+        float right = (std::min)(cam.GetViewX() + cam.VisibleW(), world.width);
+        float bottom = (std::min)(cam.GetViewY() + cam.VisibleH(), world.height);
+        if (right <= left || bottom <= top) return;
+
+        int srcX = (int)(left / GameConfig::LodCellSize);
+        int srcY = (int)(top / GameConfig::LodCellSize);
+        int srcW = (std::min)((int)ceil(right / GameConfig::LodCellSize), width) - srcX;
+        int srcH = (std::min)((int)ceil(bottom / GameConfig::LodCellSize), height) - srcY;
+        if (srcW <= 0 || srcH <= 0) return;
+
+        // Экранный прямоугольник считаем от выровненного по ячейкам источника,
+        // чтобы слой не «плыл» относительно детальных блоков
+        float scale = cam.GetScale();
+        int dstX = (int)((srcX * GameConfig::LodCellSize - cam.GetViewX()) * scale);
+        int dstY = (int)((srcY * GameConfig::LodCellSize - cam.GetViewY()) * scale);
+        int dstW = (int)(srcW * GameConfig::LodCellSize * scale);
+        int dstH = (int)(srcH * GameConfig::LodCellSize * scale);
+
+        TransparentBlt(hdc, dstX, dstY, dstW, dstH,
+            dc, srcX, srcY, srcW, srcH, TransparentColor);
+    }
+};
+
+LodLayer lodLayer;
+
+// Уровни зума: обзор всего мира, обычный, приближение к мячу
+float OverviewScale()
+{
+    return (std::min)(window.width / world.width, window.height / world.height);
+}
+
+void UpdateView(float dt)
+{
+    if (GetAsyncKeyState('W') & 0x8000)
+        camera.SetTargetScale(GameConfig::ZoomScale);
+    else if (GetAsyncKeyState('E') & 0x8000)
+        camera.SetTargetScale(OverviewScale());
     else
+        camera.SetTargetScale(1.0f);
+
+    camera.Update(ball.GetX(), ball.GetY(), dt);
+}
+
+// Отрисовка блоков с учётом уровня детализации:
+// все блоки — одним LOD-слоем, битмапами — только видимые блоки рядом с мячом
+void DrawBlocks(HDC hdc)
+{
+    float scale = camera.GetScale();
+    float r = GameConfig::LodDetailRadius;
+    float left = (std::max)(ball.GetX() - r, camera.GetViewX());
+    float top = (std::max)(ball.GetY() - r, camera.GetViewY());
+    float right = (std::min)(ball.GetX() + r, camera.GetViewX() + camera.VisibleW());
+    float bottom = (std::min)(ball.GetY() + r, camera.GetViewY() + camera.VisibleH());
+
+    if (scale < GameConfig::LodDetailMinScale || right <= left || bottom <= top)
     {
-        viewScale = 1.0f;
-        viewX = 0.0f;
-        viewY = 0.0f;
+        lodLayer.DrawView(hdc, camera);
+        return;
     }
+
+    // Список отрисовки — в кадровой арене: кандидаты из сетки, отсечённые на месте
+    ArenaArray<int> drawList = blockGrid.Collect(frameArena, left, top, right, bottom);
+    int visible = 0;
+    for (int i : drawList)
+    {
+        Block& block = blocks[i];
+        if (!block.active) continue;
+        if (block.GetX() > right || block.GetX() + block.GetW() < left) continue;
+        if (block.GetY() > bottom || block.GetY() + block.GetH() < top) continue;
+        drawList[visible++] = i;
+    }
+
+    // LOD-слой — только там, где нет детальных блоков
+    int saved = SaveDC(hdc);
+    for (int k = 0; k < visible; k++)
+        LodLayer::ExcludeBlock(hdc, blocks[drawList[k]], camera);
+    lodLayer.DrawView(hdc, camera);
+    RestoreDC(hdc, saved);
+
+    for (int k = 0; k < visible; k++)
+        blocks[drawList[k]].DrawView(hdc, camera.GetViewX(), camera.GetViewY(), scale);
 }
 
 float RandomFloat(float a, float b)
@@ -312,6 +1022,12 @@ void InitGame()
     HBITMAP ballBmp = (HBITMAP)LoadImageA(NULL, "ball.bmp", IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE);
     HBITMAP blockBmp = (HBITMAP)LoadImageA(NULL, "block.bmp", IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE);
     hBack = (HBITMAP)LoadImageA(NULL, "forest_bg.bmp", IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE);
+    if (hBack)
+    {
+        BITMAP bm; GetObject(hBack, sizeof(BITMAP), &bm);
+        hBackWidth = bm.bmWidth;
+        hBackHeight = bm.bmHeight;
+    }
 
     // Проверяем загрузку и устанавливаем битмапы
     if (playerBmp)
@@ -324,46 +1040,61 @@ void InitGame()
     }
     // Битмап для блоков будет установлен при создании каждого блока
 
+    // Мир больше окна
+    world.width = window.width * GameConfig::WorldScale;
+    world.height = window.height * GameConfig::WorldScale;
+
     // Платформа
     player.SetSize(GameConfig::PlatformWidth, GameConfig::PlatformHeight);
     player.SetSpeed(GameConfig::PlatformSpeedNormal);
-    player.SetPosition(window.width / 2.0f, window.height - 120.0f);
+    player.SetPosition(world.width / 2.0f, world.height - 120.0f);
 
     //Трассировочная точка
     balltrace.SetRadius(GameConfig::balltraceRadius);
-    balltrace.SetPosition(window.width / 2.0f, window.height - 120.0f);
+    balltrace.SetPosition(world.width / 2.0f, world.height - 120.0f);
 
     // Мяч
     ball.SetRadius(GameConfig::BallRadius);
     ball.SetSpeed(GameConfig::BallInitialSpeed);
     ball.SetDirection(-1.0f, 1.0f);
-    ball.SetPosition(window.width / 2.0f, window.height / 2.0f);
+    ball.SetPosition(world.width / 2.0f, world.height / 2.0f);
+
+    // Статические данные прошлого уровня освобождаются сбросом арены целиком
+    blocks.Destroy();
+    levelArena.Reset();
+    ballTrace.Init(levelArena, GameConfig::TraceTrailLength);
 
     // Создаем массив блоков в виде сетки
-    blocks.clear();
     int blockWidth = GameConfig::BlockWidth;
     int blockHeight = GameConfig::BlockHeight;
     int blocksPerRow = GameConfig::BlocksPerRow;
     int rows = GameConfig::BlockRows;
-    int startX = (window.width - (blocksPerRow * blockWidth + (blocksPerRow - 1) * GameConfig::BlockGap)) / 2; // центрируем
+    int startX = ((int)world.width - (blocksPerRow * blockWidth + (blocksPerRow - 1) * GameConfig::BlockGap)) / 2; // центрируем
     int startY = GameConfig::BlocksStartY;
 
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < blocksPerRow; col++) {
-            Block newBlock;
-            newBlock.SetSize(blockWidth, blockHeight);
-            newBlock.SetPosition(startX + col * (blockWidth + GameConfig::BlockGap), startY + row * (blockHeight + GameConfig::BlockGap));
-            newBlock.active = true;
+    // Количество блоков известно заранее — один массив в арене уровня
+    blocks.Allocate(levelArena, rows * blocksPerRow);
 
-            // Устанавливаем битмап для блока, если он загружен
-            if (blockBmp) {
-                newBlock.SetBitmap(blockBmp);
-            }
+    for (int i = 0; i < blocks.size(); i++) {
+        int row = i / blocksPerRow;
+        int col = i % blocksPerRow;
+        Block& newBlock = blocks[i];
+        newBlock.SetSize(blockWidth, blockHeight);
+        newBlock.SetPosition(startX + col * (blockWidth + GameConfig::BlockGap), startY + row * (blockHeight + GameConfig::BlockGap));
+        newBlock.active = true;
 
-            blocks.push_back(newBlock);
+        // Устанавливаем битмап для блока, если он загружен
+        if (blockBmp) {
+            newBlock.SetBitmap(blockBmp);
         }
     }
 
+    // Статические данные уровня для LOD-отрисовки
+    blockGrid.Build(levelArena, blocks);
+    lodLayer.Build(window.dc, blocks, LodLayer::AverageColor(window.dc, blockBmp));
+
+    // Камера сразу на мяче, без «наезда» при старте
+    camera.Snap(ball.GetX(), ball.GetY(), 1.0f);
 
 }
 // Функция проверки столкновения мяча с платформой
@@ -372,11 +1103,11 @@ void BallReset(Ball& ball)
 {
     if (GetAsyncKeyState('R') & 0x8000)
     {
-        ball.SetPosition(window.width / 2.0f, window.height / 2.0f);
+        ball.SetPosition(world.width / 2.0f, world.height / 2.0f);
     }
 }
 
-void CheckBallBlocksCollision(Ball& ball, std::vector<Block>& blocks)
+void CheckBallBlocksCollision(Ball& ball, ArenaArray<Block>& blocks)
 {
     ballactive = true;
 
@@ -384,8 +1115,17 @@ void CheckBallBlocksCollision(Ball& ball, std::vector<Block>& blocks)
     float by = ball.GetY();
     float r = ball.GetRadius();
 
-    for (auto& block : blocks)
+    // Кандидаты из сетки вокруг мяча — во временной памяти кадра,
+    // которая сразу возвращается (проверка идёт на каждом под-шаге)
+    LinearArena& scratch = frameArena;
+    size_t mark = scratch.Mark();
+    ArenaArray<int> candidates = blockGrid.Collect(scratch, bx - r, by - r, bx + r, by + r);
+    // Порядок как в массиве блоков — «первое столкновение» то же, что при полном переборе
+    std::sort(candidates.begin(), candidates.end());
+
+    for (int i : candidates)
     {
+        Block& block = blocks[i];
         if (!block.active) continue; // пропускаем неактивные блоки
 
         float blx = block.GetX();
@@ -433,6 +1173,8 @@ void CheckBallBlocksCollision(Ball& ball, std::vector<Block>& blocks)
             break; // выходим после первого столкновения
         }
     }
+
+    scratch.Rewind(mark);
 }
 
 void CheckBallPlatformCollision(Ball& ball, PlayerPlatform& platform)
@@ -471,29 +1213,22 @@ void CheckBallPlatformCollision(Ball& ball, PlayerPlatform& platform)
     }
 }
 
-void MouseMove(Ball& ball, std::vector<Block>& blocks)
+void MouseMove(Ball& ball, ArenaArray<Block>& blocks)
 {
     POINT mousePos;
     if (GetCursorPos(&mousePos) && ballactive == true)
     {
-       
-        ball.SetPosition(mousePos.x, mousePos.y);
-        balltrace.SetPosition(mousePos.x, mousePos.y);
-
-
-        float dx = balltrace.GetDX();
-        float dy = balltrace.GetDY();
-        float x = mousePos.x;
-        float y = mousePos.y;
+        // Курсор в экранных координатах — переводим в координаты мира через камеру.
+        // Мяч остаётся под курсором; камера двигается только когда курсор
+        // уводит мяч из мёртвой зоны к краю экрана (см. Camera::Update).
+        float x = camera.ScreenToWorldX((float)mousePos.x);
+        float y = camera.ScreenToWorldY((float)mousePos.y);
 
-        for (int i = 0; i < 50; i++)
-        {
-            x += dx * 10;
-            y += dy * 10;
+        ball.SetPosition(x, y);
+        balltrace.SetPosition(x, y);
 
-            POINT p{ (LONG)x, (LONG)y };
-            ballTrace.push_back(p);
-        }
+        // Добавляем точку в хвост трассировки
+        ballTrace.Push(POINT{ (LONG)x, (LONG)y });
 
         // Проверяем столкновения настоящего шара
         CheckBallBlocksCollision(ball, blocks);
@@ -546,8 +1281,8 @@ void BallStepMove(Ball& ball, float stepSize = 1.0f)
         }
 
         // Столкновение с правой стенкой
-        if (bx + r >= window.width) {
-            ball.SetPosition(window.width - r, by); // возвращаем внутрь
+        if (bx + r >= world.width) {
+            ball.SetPosition(world.width - r, by); // возвращаем внутрь
             ball.SetDirection(-fabs(dx), dy); // отражаем по X влево
         }
 
@@ -558,9 +1293,9 @@ void BallStepMove(Ball& ball, float stepSize = 1.0f)
         }
 
         // "Проигрыш": мяч улетел за нижнюю границу
-        if (by + r >= window.height) {
+        if (by + r >= world.height) {
             // Сбрасываем мяч в центр
-            ball.SetPosition(window.width / 2.0f, window.height / 2.0f);
+            ball.SetPosition(world.width / 2.0f, world.height / 2.0f);
 
             // Генерируем случайное направление вниз
             float randomDX = RandomFloat(-0.7f, 0.7f);
@@ -579,8 +1314,8 @@ void BallStepMove(Ball& ball, float stepSize = 1.0f)
 void LimitPlatform()
 {
     if (player.GetX() < 0) player.SetPosition(0, player.GetY());
-    if (player.GetX() + player.GetW() > window.width)
-        player.SetPosition(window.width - player.GetW(), player.GetY());
+    if (player.GetX() + player.GetW() > world.width)
+        player.SetPosition(world.width - player.GetW(), player.GetY());
 }
 
 
@@ -597,6 +1332,7 @@ void InitWindow() {
     window.height = r.bottom - r.top;
     window.buffer = CreateCompatibleDC(window.dc);
     SelectObject(window.buffer, CreateCompatibleBitmap(window.dc, window.width, window.height));
+    bitmapDC = CreateCompatibleDC(window.dc);
 }
 
 // Точка входа
@@ -607,67 +1343,71 @@ int main() {
 
 int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int) {
     InitWindow();
+    InitMemory();
     InitGame();
     std::srand(static_cast<unsigned int>(std::time(nullptr)));
 
     while (!GetAsyncKeyState(VK_ESCAPE)) {
+        BeginFrame();
+
         // Очистка экрана
         PatBlt(window.buffer, 0, 0, window.width, window.height, BLACKNESS);
 
         // Обновляем вид (камера/зум)
-        UpdateView();
+        UpdateView(perf.frameDt);
 
         // Рисуем фон
         if (hBack) {
-            HDC memDC = CreateCompatibleDC(window.buffer);
-            HBITMAP old = (HBITMAP)SelectObject(memDC, hBack);
-            BITMAP bm; GetObject(hBack, sizeof(BITMAP), &bm);
-            if (zoomMode)
-            {
-                // Вырезаем из фоновой текстуры область под камеру и растягиваем на окно
-                int srcX = (int)viewX;
-                int srcY = (int)viewY;
-                int srcW = (int)(window.width / viewScale);
-                int srcH = (int)(window.height / viewScale);
-                // Подстрахуем рамки в пределах текстуры
-                if (srcX < 0) srcX = 0;
-                if (srcY < 0) srcY = 0;
-                if (srcX + srcW > bm.bmWidth) srcX = bm.bmWidth - srcW;
-                if (srcY + srcH > bm.bmHeight) srcY = bm.bmHeight - srcH;
-                StretchBlt(window.buffer, 0, 0, window.width, window.height,
-                    memDC, srcX, srcY, srcW, srcH, SRCCOPY);
-            }
-            else
-            {
-                StretchBlt(window.buffer, 0, 0, window.width, window.height,
-                    memDC, 0, 0, bm.bmWidth, bm.bmHeight, SRCCOPY);
-            }
-            SelectObject(memDC, old);
-            DeleteDC(memDC);
+            HBITMAP old = (HBITMAP)SelectObject(bitmapDC, hBack);
+            // Фон натянут на весь мир: вырезаем из текстуры область под камеру.
+            // Видимую область ограничиваем миром (при отдалении мир меньше экрана).
+            float left = (std::max)(camera.GetViewX(), 0.0f);
+            float top = (std::max)(camera.GetViewY(), 0.0f);
+            float right = (std::min)(camera.GetViewX() + camera.VisibleW(), world.width);
+            float bottom = (std::min)(camera.GetViewY() + camera.VisibleH(), world.height);
+            float texScaleX = hBackWidth / world.width;
+            float texScaleY = hBackHeight / world.height;
+            float scale = camera.GetScale();
+            StretchBlt(window.buffer,
+                (int)((left - camera.GetViewX()) * scale),
+                (int)((top - camera.GetViewY()) * scale),
+                (int)((right - left) * scale),
+                (int)((bottom - top) * scale),
+                bitmapDC,
+                (int)(left * texScaleX), (int)(top * texScaleY),
+                (int)((right - left) * texScaleX), (int)((bottom - top) * texScaleY),
+                SRCCOPY);
+            SelectObject(bitmapDC, old);
         }
 
         // Рисуем платформу, мяч и блоки с учётом вида
+        float viewX = camera.GetViewX();
+        float viewY = camera.GetViewY();
+        float viewScale = camera.GetScale();
         player.DrawView(window.buffer, viewX, viewY, viewScale);
         ball.DrawView(window.buffer, viewX, viewY, viewScale);
         balltrace.DrawView(window.buffer, viewX, viewY, viewScale);
 
-        // Рисуем трассировку
+        // Рисуем трассировку (точки в координатах мира)
         for (auto& p : ballTrace)
         {
-            Ellipse(window.buffer, p.x - 2, p.y - 2, p.x + 2, p.y + 2);
+            int sx = (int)((p.x - viewX) * viewScale);
+            int sy = (int)((p.y - viewY) * viewScale);
+            Ellipse(window.buffer, sx - 2, sy - 2, sx + 2, sy + 2);
             // маленькие кружочки радиусом 2
         }
 
-        for (auto& block : blocks)
-        {
-            if (block.active) {
-                block.DrawView(window.buffer, viewX, viewY, viewScale);
-            }
-        }
+        // Блоки: дальние — LOD-слоем, ближние к мячу — битмапами
+        DrawBlocks(window.buffer);
+
+        DrawPerfHud(window.buffer);
 
         // Выводим на экран
         BitBlt(window.dc, 0, 0, window.width, window.height, window.buffer, 0, 0, SRCCOPY);
 
+        // Включение/выключение perf-HUD
+        UpdatePerfHudToggle();
+
         // Обновляем управление платформой
         bool shift = GetAsyncKeyState(VK_LSHIFT) & 0x8000;
         player.MoveShift(shift);
@@ -685,6 +1425,8 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int) {
         CheckBallPlatformCollision(ball, player);
         CheckBallBlocksCollision(ball, blocks);
         MouseMove(ball, blocks);
+
+        EndFrame();
         Sleep(3); // ~60 FPS
     }
     return 0;